@@ -0,0 +1,31 @@
+/*********************************************************
+ * File: arena.h
+ * Description: Shared memory arena backing the memory blocks handed
+   out by the memory manager. The arena is a memfd that is inherited
+   by every process, so a process and the dispatcher can access the
+   same memory block without copying it.
+ *********************************************************/
+
+#ifndef ARENA_H
+#define ARENA_H
+
+#include <stdbool.h>
+
+#define ARENA_UNIT (1024 * 1024)	//Size (in bytes) of one unit of memory (1 MB)
+
+/*Environment variables used to pass a process its memory block. A process maps
+  HOSTD_MEM_START + HOSTD_MEM_SIZE bytes at HOSTD_MEM_OFFSET and finds its block
+  HOSTD_MEM_START bytes into the mapping.*/
+#define ARENA_ENV_FD	 "HOSTD_MEM_FD"		//File descriptor of the arena
+#define ARENA_ENV_OFFSET "HOSTD_MEM_OFFSET"	//Offset (in bytes) of the page holding the start of the block
+#define ARENA_ENV_START	 "HOSTD_MEM_START"	//Offset (in bytes) of the block within that page
+#define ARENA_ENV_SIZE	 "HOSTD_MEM_SIZE"	//Size (in bytes) of the block
+
+bool arena_init(int size);					//Creates an arena of 'size' MB. Returns false if the arena could not be created.
+int arena_fd();								//Returns the arena's file descriptor. -1 if there is no arena.
+bool arena_hugepages();						//Returns true if the arena is backed by hugepages.
+void * arena_addr(int offset);				//Returns the dispatcher's address of the arena at 'offset' MB. NULL if there is no arena.
+void arena_release(int offset, int size);	//Releases the pages backing 'size' MB at 'offset' MB. Their contents become zero.
+void arena_export(int offset, int size);	//Passes a block to the calling (child) process through its environment.
+
+#endif
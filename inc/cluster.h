@@ -0,0 +1,29 @@
+/*********************************************************
+ * File: cluster.h
+ * Description: Multi-node dispatch. A coordinator reads the dispatch
+   file and forwards each process, when it arrives, to one of several
+   worker dispatchers over Unix-domain or TCP sockets. Workers report
+   their free memory and resources every tick.
+
+   Addresses are "unix:<path>" or "<host>:<port>".
+
+   Protocol (one message per line):
+     coordinator -> worker	"JOBS <n>" followed by n dispatch file lines
+							"END" once every process has been sent
+     worker -> coordinator	"STATUS <timer> <free MB> <largest block MB> <printers> <scanners>
+							 <modems> <cds> <received> <completed> <rejected>"
+   A worker closes its connection once it has received END and all of
+   its processes have finished.
+ *********************************************************/
+
+#ifndef CLUSTER_H
+#define CLUSTER_H
+
+#include <stdio.h>
+
+#define CLUSTER_MAX_WORKERS 64	//Maximum number of workers a coordinator can use
+
+void start_worker(const char *address);								//Runs a worker dispatcher that receives processes from a coordinator.
+void start_coordinator(FILE *file, char **addresses, int numWorkers);	//Distributes the processes in the dispatch file across workers.
+
+#endif
@@ -0,0 +1,37 @@
+/***********************************************
+ *File: heap.h
+ *Description: Binary min-heap of PCBs keyed by an integer.
+ *Processes with equal keys are removed in the order they were added.
+***********************************************/
+#ifndef HEAP_H
+#define HEAP_H
+
+#include <stdbool.h>
+#include "../inc/queue.h"
+
+/*Heap element*/
+struct HeapNode {
+	int key;						//Value the heap is ordered by (smallest first)
+	unsigned long order;			//Insertion counter. Breaks ties between equal keys.
+	pcbptr process;
+};
+
+/*Heap data structure*/
+struct Heap {
+	struct HeapNode * nodes;		//Array of heap elements. NULL until the first insertion.
+	unsigned int size;				//Number of elements in the heap
+	unsigned int capacity;			//Number of elements the array can hold
+	unsigned long counter;			//Number of insertions so far
+};
+typedef struct Heap heap;
+
+void init_heap(heap * h);						//Initializes the heap
+void heap_push(heap * h, int key, pcbptr value);//Adds element to heap.
+pcbptr heap_pop(heap * h);						//Removes element with the smallest key. Returns NULL if heap is empty.
+pcbptr heap_peek(heap h);						//Returns element with the smallest key without removing it.
+int heap_peek_key(heap h);						//Returns the smallest key. Heap must not be empty.
+bool isEmptyHeap(heap h);						//Returns true if heap is empty. False otherwise.
+void copy_heap(heap * dest, heap src);			//Initializes 'dest' as a copy of 'src'.
+void free_heap(heap * h);						//Frees the heap's array. Does not free the PCBs.
+
+#endif
@@ -0,0 +1,25 @@
+/*File: memory_bitmap.h
+  Description: Parameters of the bitmap memory manager ("make MEMORY=bitmap"), an alternative
+  implementation of the functions in memory_mgmt.h. Memory is divided into pages of MEM_PAGE_SIZE MB
+  and each page is tracked by one bit. First-fit is used to determine which pages to allocate next.
+*/
+
+#ifndef MEM_BITMAP_H
+#define MEM_BITMAP_H
+
+#include "../inc/memory_mgmt.h"
+#include "../inc/process_mgmt.h"
+
+#ifndef MEM_PAGE_SIZE
+#define MEM_PAGE_SIZE 1									//Size (in MB) of the unit of allocation
+#endif
+
+#if TOTAL_MEM % MEM_PAGE_SIZE != 0
+#error "TOTAL_MEM must be a multiple of MEM_PAGE_SIZE"
+#endif
+
+#define MEM_PAGES (TOTAL_MEM / MEM_PAGE_SIZE)			//Number of pages in the system
+#define MEM_WORD_BITS 64								//Number of pages tracked by each word of the bitmap
+#define MEM_WORDS ((MEM_PAGES + MEM_WORD_BITS - 1) / MEM_WORD_BITS)
+
+#endif
@@ -20,11 +20,14 @@ typedef struct mab Mab;
 typedef Mab * mabptr;
 
 int get_remaining_mem();				   //Returns the amount of free memory available in the system.
+int mem_largest_block();				   //Returns the size of the largest free memory block.
 bool mem_check(int size);				   //Returns true if memory block of size 'size' can be allocated.
 mabptr mem_alloc(int size);				   //Allocates memory block and returns a pointer to it. Returns NULL if allocation failed.
 void mem_free(mabptr memory);			   //Frees memory block.
+#ifndef MEM_BITMAP	//Only the linked list memory manager splits and merges blocks
 mabptr mem_split(mabptr memory, int size); //Splits block into two. Returns pointer to leftover block.
 bool mem_merge(mabptr top, mabptr bottom); /*Merges two blocks. Bottom is combined with top and the bottom pointer is then set to NULL.
 										     Returns true if operation was successful. False otherwise.*/
+#endif
 
 #endif
@@ -10,7 +10,9 @@
 #include "../inc/util.h"
 
 /***************Total Resources***************/
+#ifndef  TOTAL_MEM
 #define  TOTAL_MEM 	  1024	//Total amount of memory (in MB) for processes
+#endif
 #define	 RESERVED_MEM 64		//Amount of memory (in MB) reserved for real-time processes
 #define  NUM_PRINTERS 2			//Number of printers
 #define  NUM_SCANNERS 1			//Number of scanners
@@ -18,8 +20,23 @@
 #define  NUM_CDS	 2				//Number of CD drives
 /********************************************/
 
+/*Summary of the dispatcher's memory and resources*/
+struct DispatcherStatus {
+	int timer;						//Current time of the dispatcher
+	int free_mem;					//Free user memory (in MB)
+	int largest_block;				//Largest free block of user memory (in MB)
+	int printers;					//Free printers
+	int scanners;					//Free scanners
+	int modems;						//Free modems
+	int cds;						//Free CD drives
+	int received;					//Processes added to the dispatcher
+	int completed;					//Processes that ran to completion
+	int rejected;					//Processes that were not admitted
+};
+typedef struct DispatcherStatus dispatcher_status;
+
 enum indices{arrival_time, priority, cpu_time, memory_alloc, num_printers,
-					num_scanners, num_modems, num_cds};
+					num_scanners, num_modems, num_cds, deadline};	//deadline is optional (0 = none)
 					
 pcbptr create_pcb();											//Returns a pointer to an empty PCB.
 bool areEmptyQueues();											//Returns true if all dispatcher queues are empty.
@@ -30,10 +47,19 @@ void start_process(pcbptr process);								//Starts process.
 void restart_process(pcbptr process);							//Restarts suspended process.
 void suspend_process(pcbptr process);							//Suspends process
 void kill_process(pcbptr process); 								//Terminates process and frees its resoures.
-void init_dispatcher(FILE *file);								//Initializes dispatchers
+void init_dispatcher(FILE *file);								//Initializes dispatchers. If file is NULL, the dispatcher starts without processes.
 void start_dispatcher();											//Starts the process dispatcher
+void dispatch_tick();											//Runs one pass of the dispatcher.
+void wait_quantum();											//Sleeps for one quantum and advances the dispatcher timer.
+bool is_dispatcher_idle();										//Returns true if there are no processes left in the system.
+void report_deadlines();										//Prints deadline statistics if any process had a deadline.
+void add_process(int * processInfo);							//Adds a process that is admitted at its arrival time.
+int get_dispatcher_timer();										//Returns the current time of the dispatcher.
+void get_dispatcher_status(dispatcher_status * status);			//Fills in a summary of the dispatcher's memory and resources.
 void init_process(pcbptr process, int * processInfo);		//Initializes process block
 void placeInQueue(pcbptr process);								//Adds process to appropriate queue based on its priority level.
+void set_edf_mode(bool enabled);								//Schedules real-time processes earliest-deadline-first instead of first-come-first-serve.
+bool edf_admissible(pcbptr process);							//Returns true if the real-time process can be admitted without any real-time process missing its deadline.
 
 
 #endif
@@ -0,0 +1,92 @@
+/*********************************************************
+ * File: profile.h
+ * Description: Dispatcher overhead profiler and probe points.
+   Latency histograms are only compiled in when HOSTD_PROFILE is
+   defined ("make PROFILE=1"). Otherwise the PROF_* macros expand to
+   nothing. Probe points are always compiled in; they are single
+   nops that perf and bpftrace can attach to as usdt:./hostd:hostd:<name>.
+ *********************************************************/
+
+#ifndef PROFILE_H
+#define PROFILE_H
+
+#include <stdint.h>
+
+/*Profiled events*/
+enum prof_events{PROF_START, PROF_SUSPEND, PROF_KILL, PROF_MEM_ALLOC, PROF_MEM_FREE,
+					PROF_LOOP, PROF_EVENTS};
+
+#ifdef HOSTD_PROFILE
+
+#define PROF_BEGIN(t)			uint64_t t = prof_now()
+#define PROF_END(event, t)		prof_record(event, prof_now() - (t))
+/*Times fork until the child has called exec (measured by a close-on-exec pipe)*/
+#define PROF_EXEC_BEGIN(t)		PROF_BEGIN(t); int t##_pipe[2]; prof_exec_pipe(t##_pipe)
+#define PROF_EXEC_END(event, t)	prof_exec_wait(t##_pipe); PROF_END(event, t)
+#define PROF_EXEC_CANCEL(t)		prof_exec_cancel(t##_pipe)
+
+void prof_init();									//Installs the SIGUSR1 handler and dumps the histograms at exit.
+void prof_poll();									//Dumps the histograms if SIGUSR1 was received since the last call.
+void prof_dump();									//Prints the histograms to stderr.
+uint64_t prof_now();								//Returns a monotonic timestamp in nanoseconds.
+void prof_record(int event, uint64_t nanoseconds);	//Adds a sample to an event's histogram.
+void prof_exec_pipe(int fds[2]);					//Opens a close-on-exec pipe. Both descriptors are -1 on failure.
+void prof_exec_wait(int fds[2]);					//Waits until every process holding the pipe's write end has called exec.
+void prof_exec_cancel(int fds[2]);					//Closes the pipe without waiting, for when fork fails.
+
+#else
+
+#define PROF_BEGIN(t)
+#define PROF_END(event, t)
+#define PROF_EXEC_BEGIN(t)
+#define PROF_EXEC_END(event, t)
+#define PROF_EXEC_CANCEL(t)
+#define prof_init()
+#define prof_poll()
+#define prof_dump()
+
+#endif
+
+/*Probe points. Each one adds a nop and a .note.stapsdt entry describing it (the format of <sys/sdt.h>).
+  Arguments are passed as 64-bit signed integers.*/
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__aarch64__))
+
+#define HOSTD_PROBE_NOTE(name, args, ...) \
+	__asm__ __volatile__ ( \
+		"990:	nop\n" \
+		"		.pushsection .note.stapsdt,\"?\",\"note\"\n" \
+		"		.balign 4\n" \
+		"		.4byte 992f-991f, 994f-993f, 3\n" \
+		"991:	.asciz \"stapsdt\"\n" \
+		"992:	.balign 4\n" \
+		"993:	.8byte 990b\n" \
+		"		.8byte _.stapsdt.base\n" \
+		"		.8byte 0\n" \
+		"		.asciz \"hostd\"\n" \
+		"		.asciz \"" #name "\"\n" \
+		"		.asciz \"" args "\"\n" \
+		"994:	.balign 4\n" \
+		"		.popsection\n" \
+		"		.ifndef _.stapsdt.base\n" \
+		"		.pushsection .stapsdt.base,\"aG\",\"progbits\",.stapsdt.base,comdat\n" \
+		"		.weak _.stapsdt.base\n" \
+		"		.hidden _.stapsdt.base\n" \
+		"_.stapsdt.base: .space 1\n" \
+		"		.size _.stapsdt.base, 1\n" \
+		"		.popsection\n" \
+		"		.endif\n" \
+		:: __VA_ARGS__)
+
+#define HOSTD_PROBE0(name)			HOSTD_PROBE_NOTE(name, "")
+#define HOSTD_PROBE1(name, a)		HOSTD_PROBE_NOTE(name, "-8@%0", "nor"((int64_t)(a)))
+#define HOSTD_PROBE2(name, a, b)	HOSTD_PROBE_NOTE(name, "-8@%0 -8@%1", "nor"((int64_t)(a)), "nor"((int64_t)(b)))
+
+#else
+
+#define HOSTD_PROBE0(name)
+#define HOSTD_PROBE1(name, a)
+#define HOSTD_PROBE2(name, a, b)
+
+#endif
+
+#endif
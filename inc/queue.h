@@ -23,6 +23,7 @@ struct PCB {
 	int arrival_time;	
 	int remaining_cpu_time;
 	int priority;
+	int deadline;					//Time by which the process must finish. 0 if the process has no deadline.
 	int status;						//Status of the process
 	int * info;
 	mabptr memory;					//Allocated memory block. NULL no memory has been allocated.	
@@ -8,10 +8,13 @@
 
 #define DEBUG false
 #define NEWLINE '\n'
+#define REQUIRED_FIELDS 8	//Number of values every line of the dispatch file must contain
+#define MAX_FIELDS 9		//Number of values including the optional trailing deadline
 
 int arraySize(const void** array); 				//Returns number of elements in NULL-terminated array
-int * readInfo(FILE *file); 		  				/*Reads a line in format "<int1>, <int2>, ..., <int8>" from a filestream and returns the int values in an
-															  malloced array of size 8.*/
+int * readInfo(FILE *file); 		  				/*Reads a line in format "<int1>, <int2>, ..., <int8>[, <int9>]" from a filestream and returns the int
+															  values in an malloced array of size MAX_FIELDS. Missing optional values are set to 0.*/
+int * parseInfo(const char *line);				//Same as readInfo(), but parses a NULL-terminated string.
 void read_file(FILE* file, char* buffer, size_t size); //Reads the contents of a file and stores them in a string.
 
 #endif
@@ -0,0 +1,37 @@
+/***********************************************
+ *File: wheel.h
+ *Description: Hierarchical timer wheel that holds processes until
+ *their arrival time. Processes can be added in any order.
+ *Arrivals too far in the future for the wheel wait in a min-heap.
+***********************************************/
+#ifndef WHEEL_H
+#define WHEEL_H
+
+#include <stdbool.h>
+#include "../inc/queue.h"
+#include "../inc/heap.h"
+
+#define WHEEL_BITS 6							//Number of time bits covered by each level
+#define WHEEL_SLOTS (1 << WHEEL_BITS)			//Number of slots in each level
+#define WHEEL_MASK (WHEEL_SLOTS - 1)
+#define WHEEL_LEVELS 4							/*Number of levels. The wheel spans 2^(WHEEL_BITS * WHEEL_LEVELS) ticks,
+												  which must be less than 2^32.*/
+
+/*Timer wheel data structure.
+  Level n holds the processes that arrive in the current level n+1 slot but not in the current level n slot.*/
+struct TimerWheel {
+	unsigned int current;						//Next tick to be processed
+	unsigned int count;							//Number of processes in the wheel (including due processes)
+	queue slots[WHEEL_LEVELS][WHEEL_SLOTS];
+	queue due;									//Processes whose arrival time has been reached
+	heap overflow;								//Processes that arrive after the span of the wheel
+};
+typedef struct TimerWheel timer_wheel;
+
+void init_wheel(timer_wheel * w);						//Initializes the wheel
+void wheel_insert(timer_wheel * w, pcbptr process);		//Adds process to the wheel. It becomes due at its arrival time.
+void wheel_advance(timer_wheel * w, unsigned int time);	//Makes every process that arrives at or before 'time' due.
+pcbptr wheel_pop_due(timer_wheel * w);					//Removes a due process. Returns NULL if no process is due.
+bool isEmptyWheel(timer_wheel * w);						//Returns true if the wheel holds no processes. False otherwise.
+
+#endif
@@ -0,0 +1,128 @@
+/*********************************************************
+ * File: arena.c
+ * Description: Shared memory arena backed by a memfd. Hugepages are
+   used when enough of them are reserved in the system.
+ *********************************************************/
+
+#define _GNU_SOURCE	//For memfd_create and fallocate
+
+#include <fcntl.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#include "../inc/arena.h"
+#include "../inc/util.h"
+
+#define DEBUG_ARENA false	//Debug flag specific to this file
+
+int mArenaFd = -1;			//File descriptor of the arena. -1 if there is no arena.
+size_t mArenaSize = 0;		//Size of the arena in bytes
+char * mArenaBase = NULL;	//Dispatcher's mapping of the arena
+bool mArenaHuge = false;	//True if the arena is backed by hugepages
+size_t mArenaPage = 0;		//Size (in bytes) of the pages backing the arena
+
+/*Creates a memfd of 'size' bytes and maps it. Returns false and leaves no arena behind on failure.
+  Internal to this module.*/
+bool arena_create(size_t size, unsigned int flags) {
+	int fd = memfd_create("hostd-arena", flags);
+	if (fd < 0)
+		return false;
+
+	/*Shared hugetlb mappings reserve their pages up front, so mapping fails if too few are available.*/
+	if (ftruncate(fd, size) != 0) {
+		close(fd);
+		return false;
+	}
+	void * base = mmap(NULL, size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+	if (base == MAP_FAILED) {
+		close(fd);
+		return false;
+	}
+
+	/*The block size of a hugetlbfs file is its hugepage size*/
+	struct stat info;
+	mArenaPage = fstat(fd, &info) == 0 && info.st_blksize > 0 ? (size_t)info.st_blksize : (size_t)getpagesize();
+	mArenaFd = fd;
+	mArenaSize = size;
+	mArenaBase = base;
+	return true;
+}
+
+//Creates an arena of 'size' MB
+bool arena_init(int size) {
+	if (mArenaFd >= 0)
+		return true;
+
+	size_t bytes = (size_t)size * ARENA_UNIT;
+	/*The descriptor is deliberately not close-on-exec so that processes inherit it.*/
+	mArenaHuge = arena_create(bytes, MFD_HUGETLB);
+	if (!mArenaHuge && !arena_create(bytes, 0))
+		return false;
+
+	if (DEBUG || DEBUG_ARENA)
+		printf("\tArena of %dMB created (fd = %d, hugepages = %s, page size = %zu)\n", size, mArenaFd,
+				mArenaHuge ? "yes" : "no", mArenaPage);
+	return true;
+}
+
+//Returns the arena's file descriptor
+int arena_fd() {
+	return mArenaFd;
+}
+
+//Returns true if the arena is backed by hugepages
+bool arena_hugepages() {
+	return mArenaHuge;
+}
+
+//Returns the dispatcher's address of the arena at 'offset' MB
+void * arena_addr(int offset) {
+	if (mArenaBase == NULL)
+		return NULL;
+	return mArenaBase + (size_t)offset * ARENA_UNIT;
+}
+
+//Releases the pages backing 'size' MB at 'offset' MB
+void arena_release(int offset, int size) {
+	if (mArenaFd < 0 || size <= 0)
+		return;
+
+	/*Only whole pages can be released. Pages the range shares with its neighbours are cleared instead.*/
+	size_t start = (size_t)offset * ARENA_UNIT;
+	size_t end = start + (size_t)size * ARENA_UNIT;
+	size_t holeStart = (start + mArenaPage - 1) / mArenaPage * mArenaPage;
+	size_t holeEnd = end / mArenaPage * mArenaPage;
+	if (holeStart >= holeEnd) {
+		memset(mArenaBase + start, 0, end - start);
+		return;
+	}
+	memset(mArenaBase + start, 0, holeStart - start);
+	memset(mArenaBase + holeEnd, 0, end - holeEnd);
+
+	if (fallocate(mArenaFd, FALLOC_FL_PUNCH_HOLE | FALLOC_FL_KEEP_SIZE,
+			holeStart, holeEnd - holeStart) != 0 && (DEBUG || DEBUG_ARENA))
+		printf("\tERROR - Could not release arena memory: offset = %d  mem = %dMB\n", offset, size);
+}
+
+/*Passes a block to the calling (child) process through its environment. Hugetlbfs can only be
+  mapped at whole hugepages, so the offset is rounded down to a page and the block's start within
+  that page is passed separately.*/
+void arena_export(int offset, int size) {
+	if (mArenaFd < 0)
+		return;
+
+	size_t start = (size_t)offset * ARENA_UNIT;
+	size_t window = start / mArenaPage * mArenaPage;
+	char value[32];
+	snprintf(value, sizeof(value), "%d", mArenaFd);
+	setenv(ARENA_ENV_FD, value, 1);
+	snprintf(value, sizeof(value), "%zu", window);
+	setenv(ARENA_ENV_OFFSET, value, 1);
+	snprintf(value, sizeof(value), "%zu", start - window);
+	setenv(ARENA_ENV_START, value, 1);
+	snprintf(value, sizeof(value), "%zu", (size_t)size * ARENA_UNIT);
+	setenv(ARENA_ENV_SIZE, value, 1);
+}
@@ -0,0 +1,524 @@
+/*********************************************************
+ * File: cluster.c
+ * Description: Multi-node dispatch. Contains the coordinator, which
+   places processes on workers using the workers' last reported
+   memory and resources, and the worker loop around the dispatcher.
+ *********************************************************/
+
+#define _GNU_SOURCE	//For getaddrinfo and MSG_NOSIGNAL
+
+#include <errno.h>
+#include <netdb.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <stdarg.h>
+#include <stdbool.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <time.h>
+#include <unistd.h>
+#include "../inc/cluster.h"
+#include "../inc/process_mgmt.h"
+#include "../inc/profile.h"
+#include "../inc/wheel.h"
+
+#define DEBUG_CLUSTER false		//Debug flag specific to this file
+#define BUFFER_SIZE 65536		//Size of the receive buffer of each connection
+#define LINE_SIZE 256			//Maximum length of a message line
+#define CONNECT_ATTEMPTS 10		//Number of times (one second apart) the coordinator tries to reach a worker
+#define COORDINATOR_QUANTUM 1	//Length of a coordinator tick (in seconds). Matches the dispatcher's quantum.
+
+/*Buffered receiving end of a socket*/
+struct Connection {
+	int fd;
+	size_t length;				//Number of bytes in the buffer
+	char buffer[BUFFER_SIZE];
+};
+typedef struct Connection connection;
+
+/*Growable buffer holding the lines of a message*/
+struct Message {
+	char * data;
+	size_t length;
+	size_t capacity;
+	int lines;					//Number of lines in the message
+};
+typedef struct Message message;
+
+/*Memory and resources of a process placed on a worker*/
+struct Placement {
+	int memory;
+	int printers;
+	int scanners;
+	int modems;
+	int cds;
+};
+typedef struct Placement placement;
+
+/*Worker as seen by the coordinator*/
+struct Worker {
+	const char * address;
+	connection conn;
+	dispatcher_status status;	//Last summary from the worker, minus the processes placed on it that it had not received
+	int assigned;				//Number of processes placed on the worker
+	placement * pending;		//Processes placed on the worker that it had not received at its last status, oldest first
+	int numPending;
+	int pendingCapacity;
+	bool reported;				//True once the worker has sent a status
+	bool done;					//True once the worker has closed its connection
+	message batch;				//Processes to send at the end of the current tick
+};
+typedef struct Worker worker;
+
+/*Opens a socket for an address. Binds it and listens if 'listening' is true. Otherwise, connects it.
+  Returns -1 on failure. Internal to this module.*/
+int open_socket(const char * address, bool listening) {
+	/*Unix-domain socket*/
+	if (strncmp(address, "unix:", 5) == 0) {
+		struct sockaddr_un local;
+		int fd = socket(AF_UNIX, SOCK_STREAM, 0);
+		if (fd < 0)
+			return -1;
+		memset(&local, 0, sizeof(local));
+		local.sun_family = AF_UNIX;
+		strncpy(local.sun_path, address + 5, sizeof(local.sun_path) - 1);
+
+		if (listening) {
+			unlink(local.sun_path);	//Remove socket left behind by an earlier worker
+			if (bind(fd, (struct sockaddr *)&local, sizeof(local)) == 0 && listen(fd, 1) == 0)
+				return fd;
+		} else if (connect(fd, (struct sockaddr *)&local, sizeof(local)) == 0)
+			return fd;
+		close(fd);
+		return -1;
+	}
+
+	/*TCP socket. The port follows the last ':' so that the host may be empty.*/
+	char host[LINE_SIZE];
+	const char * port = strrchr(address, ':');
+	if (port == NULL || port - address >= sizeof(host))
+		return -1;
+	memcpy(host, address, port - address);
+	host[port - address] = '\0';
+	port++;
+
+	struct addrinfo hints, *results, *result;
+	memset(&hints, 0, sizeof(hints));
+	hints.ai_family = AF_UNSPEC;
+	hints.ai_socktype = SOCK_STREAM;
+	hints.ai_flags = listening ? AI_PASSIVE : 0;
+	if (getaddrinfo(host[0] != '\0' ? host : NULL, port, &hints, &results) != 0)
+		return -1;
+
+	int fd = -1;
+	for (result = results; result != NULL && fd < 0; result = result->ai_next) {
+		int one = 1;
+		fd = socket(result->ai_family, result->ai_socktype, result->ai_protocol);
+		if (fd < 0)
+			continue;
+		setsockopt(fd, IPPROTO_TCP, TCP_NODELAY, &one, sizeof(one));
+		if (listening) {
+			setsockopt(fd, SOL_SOCKET, SO_REUSEADDR, &one, sizeof(one));
+			if (bind(fd, result->ai_addr, result->ai_addrlen) == 0 && listen(fd, 1) == 0)
+				break;
+		} else if (connect(fd, result->ai_addr, result->ai_addrlen) == 0)
+			break;
+		close(fd);
+		fd = -1;
+	}
+	freeaddrinfo(results);
+	return fd;
+}
+
+//Sends a whole buffer. Returns false if the connection failed. Internal to this module.
+bool send_all(int fd, const char * data, size_t length) {
+	while (length > 0) {
+		ssize_t sent = send(fd, data, length, MSG_NOSIGNAL);
+		if (sent < 0 && errno == EINTR)
+			continue;
+		if (sent <= 0)
+			return false;
+		data += sent;
+		length -= sent;
+	}
+	return true;
+}
+
+//Initializes a connection. Internal to this module.
+void init_connection(connection * conn, int fd) {
+	conn->fd = fd;
+	conn->length = 0;
+}
+
+/*Reads whatever data has arrived without blocking. Returns false if the connection
+  was closed or failed. Internal to this module.*/
+bool connection_fill(connection * conn) {
+	while (conn->length < BUFFER_SIZE) {
+		ssize_t received = recv(conn->fd, conn->buffer + conn->length, BUFFER_SIZE - conn->length, MSG_DONTWAIT);
+		if (received > 0)
+			conn->length += received;
+		else if (received < 0 && errno == EINTR)
+			continue;
+		else if (received < 0 && (errno == EAGAIN || errno == EWOULDBLOCK))
+			return true;
+		else
+			return false;
+	}
+	return true;
+}
+
+/*Removes the next complete line from the buffer and stores it (without the newline) in 'line'.
+  Returns false if no complete line has arrived. Internal to this module.*/
+bool connection_readline(connection * conn, char * line, size_t size) {
+	char * end = memchr(conn->buffer, NEWLINE, conn->length);
+	if (end == NULL) {
+		if (conn->length == BUFFER_SIZE)	//Line too long to ever fit. Discard it.
+			conn->length = 0;
+		return false;
+	}
+
+	size_t length = end - conn->buffer;
+	size_t copied = length < size - 1 ? length : size - 1;
+	memcpy(line, conn->buffer, copied);
+	line[copied] = '\0';
+
+	conn->length -= length + 1;
+	memmove(conn->buffer, end + 1, conn->length);
+	return true;
+}
+
+//Initializes an empty message. Internal to this module.
+void init_message(message * msg) {
+	msg->data = NULL;
+	msg->length = 0;
+	msg->capacity = 0;
+	msg->lines = 0;
+}
+
+//Appends a formatted line to a message. Internal to this module.
+void message_printf(message * msg, const char * format, ...) {
+	va_list args;
+	if (msg->capacity - msg->length < LINE_SIZE) {
+		msg->capacity = msg->capacity == 0 ? BUFFER_SIZE : msg->capacity * 2;
+		msg->data = realloc(msg->data, msg->capacity);
+		if (msg->data == NULL) {
+			printf("ERROR - Could not grow message buffer\n");
+			exit(EXIT_FAILURE);
+		}
+	}
+	va_start(args, format);
+	msg->length += vsnprintf(msg->data + msg->length, msg->capacity - msg->length, format, args);
+	va_end(args);
+	msg->lines++;
+}
+
+//Sends the worker dispatcher's status to the coordinator. Internal to this module.
+void send_status(int fd) {
+	dispatcher_status status;
+	char line[LINE_SIZE];
+
+	get_dispatcher_status(&status);
+	int length = snprintf(line, sizeof(line), "STATUS %d %d %d %d %d %d %d %d %d %d\n",
+			status.timer, status.free_mem, status.largest_block, status.printers, status.scanners,
+			status.modems, status.cds, status.received, status.completed, status.rejected);
+	send_all(fd, line, length);
+}
+
+//Runs a worker dispatcher that receives processes from a coordinator
+void start_worker(const char * address) {
+	int listener = open_socket(address, true);
+	if (listener < 0) {
+		printf("ERROR - Could not listen on \"%s\"\n", address);
+		exit(EXIT_FAILURE);
+	}
+	printf("Worker waiting for coordinator on %s\n", address);
+	int fd = accept(listener, NULL, NULL);
+	close(listener);
+	if (fd < 0) {
+		printf("ERROR - Could not accept coordinator connection\n");
+		exit(EXIT_FAILURE);
+	}
+
+	static connection conn;
+	char line[LINE_SIZE];
+	bool ended = false;	//True once the coordinator has sent every process
+	int expected = 0;	//Number of process lines still to come in the current message
+
+	init_connection(&conn, fd);
+	init_dispatcher(NULL);
+	prof_init();
+	send_status(fd);
+
+	do {
+		/*Add the processes received since the last tick. They arrive now.*/
+		if (!ended && !connection_fill(&conn)) {
+			printf("\nERROR - Lost connection to coordinator\n\n");
+			ended = true;
+		}
+		while (connection_readline(&conn, line, sizeof(line))) {
+			if (expected > 0) {
+				int * processInfo = parseInfo(line);
+				expected--;
+				if (processInfo == NULL)
+					continue;
+				processInfo[arrival_time] = get_dispatcher_timer();
+				add_process(processInfo);
+			}
+			else if (sscanf(line, "JOBS %d", &expected) == 1) {
+				if (DEBUG || DEBUG_CLUSTER)
+					printf("\tReceived %d processes\n", expected);
+			}
+			else if (strcmp(line, "END") == 0)
+				ended = true;
+		}
+
+		dispatch_tick();
+		send_status(fd);
+		wait_quantum();
+	} while (!ended || !is_dispatcher_idle());
+
+	send_status(fd);
+	close(fd);
+	report_deadlines();
+}
+
+//Subtracts a placed process's memory and resources from a worker's status. Internal to this module.
+void apply_placement(dispatcher_status * status, placement * p) {
+	status->free_mem -= p->memory;
+	if (status->largest_block > status->free_mem)
+		status->largest_block = status->free_mem;
+	status->printers -= p->printers;
+	status->scanners -= p->scanners;
+	status->modems -= p->modems;
+	status->cds -= p->cds;
+}
+
+/*Replaces a worker's status. Processes are sent in the order they were placed, so the ones the worker
+  has not counted as received are the last ones placed. They are still in flight and are subtracted
+  again. Internal to this module.*/
+void update_status(worker * w, dispatcher_status * status) {
+	int inFlight = w->assigned - status->received;
+	int i;
+
+	if (inFlight < 0)
+		inFlight = 0;
+	if (inFlight < w->numPending) {
+		memmove(w->pending, w->pending + w->numPending - inFlight, inFlight * sizeof(placement));
+		w->numPending = inFlight;
+	}
+	w->status = *status;
+	for (i = 0; i < w->numPending; i++)
+		apply_placement(&w->status, &w->pending[i]);
+}
+
+//Reads the latest status of every worker and marks workers that have finished. Internal to this module.
+void receive_statuses(worker * workers, int numWorkers) {
+	char line[LINE_SIZE];
+	int i;
+
+	for (i = 0; i < numWorkers; i++) {
+		worker * w = &workers[i];
+		if (w->done)
+			continue;
+		bool open = connection_fill(&w->conn);
+		while (connection_readline(&w->conn, line, sizeof(line))) {
+			dispatcher_status status;
+			if (sscanf(line, "STATUS %d %d %d %d %d %d %d %d %d %d", &status.timer, &status.free_mem,
+					&status.largest_block, &status.printers, &status.scanners, &status.modems, &status.cds,
+					&status.received, &status.completed, &status.rejected) == 10) {
+				update_status(w, &status);
+				w->reported = true;
+			}
+		}
+		if (!open) {
+			close(w->conn.fd);
+			w->done = true;
+		}
+	}
+}
+
+/*Chooses the worker for a process. User jobs go to the worker with the most free memory whose
+  largest free block and free resources fit the job. Real-time jobs, and user jobs that fit nowhere,
+  go to the worker with the fewest unfinished processes. Returns NULL if every worker has finished.
+  Internal to this module.*/
+worker * place_process(worker * workers, int numWorkers, int * info) {
+	worker * best = NULL;		//Worker with the most free memory that fits the job
+	worker * leastBusy = NULL;	//Worker with the fewest unfinished processes
+	int fewest = 0;
+	int i;
+
+	for (i = 0; i < numWorkers; i++) {
+		worker * w = &workers[i];
+		if (w->done)
+			continue;
+
+		int unfinished = w->numPending + w->status.received - w->status.completed - w->status.rejected;
+		if (leastBusy == NULL || unfinished < fewest) {
+			leastBusy = w;
+			fewest = unfinished;
+		}
+
+		if (info[priority] != 0 &&
+				info[memory_alloc] <= w->status.largest_block &&
+				info[num_printers] <= w->status.printers && info[num_scanners] <= w->status.scanners &&
+				info[num_modems] <= w->status.modems && info[num_cds] <= w->status.cds &&
+				(best == NULL || w->status.free_mem > best->status.free_mem))
+			best = w;
+	}
+	if (best == NULL)
+		best = leastBusy;
+	if (best == NULL)
+		return NULL;
+
+	/*Account for the process until the worker reports that it has received it. Real-time
+	  processes use the reserved memory and no resources.*/
+	placement p = {0, 0, 0, 0, 0};
+	if (info[priority] != 0) {
+		p.memory = info[memory_alloc];
+		p.printers = info[num_printers];
+		p.scanners = info[num_scanners];
+		p.modems = info[num_modems];
+		p.cds = info[num_cds];
+	}
+	if (best->numPending == best->pendingCapacity) {
+		best->pendingCapacity = best->pendingCapacity == 0 ? 16 : best->pendingCapacity * 2;
+		best->pending = realloc(best->pending, best->pendingCapacity * sizeof(placement));
+		if (best->pending == NULL) {
+			printf("ERROR - Could not grow pending process list\n");
+			exit(EXIT_FAILURE);
+		}
+	}
+	best->pending[best->numPending++] = p;
+	best->assigned++;
+	apply_placement(&best->status, &p);
+	return best;
+}
+
+//Sends every worker the processes placed on it during this tick. Internal to this module.
+void send_batches(worker * workers, int numWorkers) {
+	char header[LINE_SIZE];
+	int i;
+
+	for (i = 0; i < numWorkers; i++) {
+		worker * w = &workers[i];
+		if (w->batch.lines == 0)
+			continue;
+		int length = snprintf(header, sizeof(header), "JOBS %d\n", w->batch.lines);
+		if (!w->done && (!send_all(w->conn.fd, header, length) ||
+				!send_all(w->conn.fd, w->batch.data, w->batch.length)))
+			printf("\nERROR - Could not send %d processes to worker %s\n\n", w->batch.lines, w->address);
+		w->batch.length = 0;
+		w->batch.lines = 0;
+	}
+}
+
+//Distributes the processes in the dispatch file across workers
+void start_coordinator(FILE * file, char ** addresses, int numWorkers) {
+	worker * workers = calloc(numWorkers, sizeof(worker));
+	static timer_wheel input;	//Processes that have not arrived yet
+	int timer = 0;
+	int total = 0;
+	int i, attempt;
+
+	/*Connect to the workers. They may still be starting up.*/
+	for (i = 0; i < numWorkers; i++) {
+		int fd = -1;
+		for (attempt = 0; attempt < CONNECT_ATTEMPTS && fd < 0; attempt++) {
+			fd = open_socket(addresses[i], false);
+			if (fd < 0)
+				sleep(1);
+		}
+		if (fd < 0) {
+			printf("ERROR - Could not connect to worker \"%s\"\n", addresses[i]);
+			exit(EXIT_FAILURE);
+		}
+		workers[i].address = addresses[i];
+		init_connection(&workers[i].conn, fd);
+		init_message(&workers[i].batch);
+	}
+
+	/*Wait for the first status of every worker so processes can be placed from the start*/
+	for (attempt = 0; attempt < CONNECT_ATTEMPTS * 100; attempt++) {
+		bool reported = true;
+		receive_statuses(workers, numWorkers);
+		for (i = 0; i < numWorkers; i++)
+			reported = reported && (workers[i].reported || workers[i].done);
+		if (reported)
+			break;
+		usleep(10000);
+	}
+
+	/*Load the dispatch file. It does not need to be sorted by arrival time.*/
+	init_wheel(&input);
+	while (!feof(file)) {
+		int * processInfo = readInfo(file);
+		if (processInfo == NULL)
+			continue;
+		pcbptr process = create_pcb();
+		init_process(process, processInfo);
+		wheel_insert(&input, process);
+		total++;
+	}
+	printf("Coordinator dispatching %d processes to %d workers\n", total, numWorkers);
+
+	struct timespec start, end;
+	clock_gettime(CLOCK_MONOTONIC, &start);
+	bool ended = false;	//True once every process has been sent
+	bool active = true;	//True while any worker is still running
+
+	while (active) {
+		receive_statuses(workers, numWorkers);
+
+		/*Place the processes that arrive during this tick*/
+		pcbptr process;
+		wheel_advance(&input, timer);
+		while ((process = wheel_pop_due(&input)) != NULL) {
+			int * info = process->info;
+			worker * w = place_process(workers, numWorkers, info);
+			if (w == NULL)
+				printf("\nERROR - No worker left to run process - job deleted\n\n");
+			else
+				message_printf(&w->batch, "%d, %d, %d, %d, %d, %d, %d, %d, %d\n", info[arrival_time],
+						info[priority], info[cpu_time], info[memory_alloc], info[num_printers],
+						info[num_scanners], info[num_modems], info[num_cds], info[deadline]);
+			free(info);
+			free(process);
+		}
+		send_batches(workers, numWorkers);
+
+		if (!ended && isEmptyWheel(&input)) {
+			for (i = 0; i < numWorkers; i++)
+				if (!workers[i].done)
+					send_all(workers[i].conn.fd, "END\n", 4);
+			ended = true;
+		}
+
+		active = false;
+		for (i = 0; i < numWorkers; i++)
+			active = active || !workers[i].done;
+		if (active) {
+			sleep(COORDINATOR_QUANTUM);
+			timer += COORDINATOR_QUANTUM;
+		}
+	}
+	clock_gettime(CLOCK_MONOTONIC, &end);
+
+	/*Report how the processes were spread and the aggregate throughput*/
+	double seconds = (end.tv_sec - start.tv_sec) + (end.tv_nsec - start.tv_nsec) / 1e9;
+	int completed = 0, rejected = 0;
+	printf("\n%-32s %10s %10s %10s\n", "worker", "assigned", "completed", "rejected");
+	for (i = 0; i < numWorkers; i++) {
+		printf("%-32s %10d %10d %10d\n", workers[i].address, workers[i].assigned,
+				workers[i].status.completed, workers[i].status.rejected);
+		completed += workers[i].status.completed;
+		rejected += workers[i].status.rejected;
+		free(workers[i].batch.data);
+		free(workers[i].pending);
+	}
+	printf("\n%d workers completed %d processes (%d rejected) in %.1f seconds: %.3f processes/second\n",
+			numWorkers, completed, rejected, seconds, seconds > 0 ? completed / seconds : 0.0);
+	free(workers);
+}
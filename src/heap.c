@@ -0,0 +1,117 @@
+/***********************************************
+ * File: heap.c
+ * Description: Binary min-heap of PCBs keyed by an integer.
+***********************************************/
+
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+#include "../inc/heap.h"
+
+#define INITIAL_CAPACITY 16	//Number of elements allocated on the first insertion
+
+//Returns true if node 'a' must be removed before node 'b'. Internal to this module.
+bool precedes(const struct HeapNode * a, const struct HeapNode * b) {
+	return a->key < b->key || (a->key == b->key && a->order < b->order);
+}
+
+//Initializes an empty heap
+void init_heap(heap * h) {
+	h->nodes = NULL;
+	h->size = 0;
+	h->capacity = 0;
+	h->counter = 0;
+}
+
+//Adds element to heap
+void heap_push(heap * h, int key, pcbptr value) {
+	/*Grow the array if it is full*/
+	if (h->size == h->capacity) {
+		unsigned int capacity = h->capacity == 0 ? INITIAL_CAPACITY : h->capacity * 2;
+		struct HeapNode * nodes = realloc(h->nodes, sizeof(struct HeapNode) * capacity);
+		if (nodes == NULL) {
+			printf("ERROR - Could not grow heap\n");
+			exit(EXIT_FAILURE);
+		}
+		h->nodes = nodes;
+		h->capacity = capacity;
+	}
+
+	struct HeapNode node = {key, h->counter++, value};
+	unsigned int i = h->size++;
+
+	/*Move the new element up until its parent precedes it*/
+	while (i > 0) {
+		unsigned int parent = (i - 1) / 2;
+		if (!precedes(&node, &h->nodes[parent]))
+			break;
+		h->nodes[i] = h->nodes[parent];
+		i = parent;
+	}
+	h->nodes[i] = node;
+}
+
+//Removes element with the smallest key
+pcbptr heap_pop(heap * h) {
+	if (h == NULL || h->size == 0)
+		return NULL;
+
+	pcbptr top = h->nodes[0].process;
+	struct HeapNode last = h->nodes[--h->size];
+	unsigned int i = 0;
+
+	/*Move the last element down from the root until it precedes both of its children*/
+	while (true) {
+		unsigned int child = 2 * i + 1;
+		if (child >= h->size)
+			break;
+		if (child + 1 < h->size && precedes(&h->nodes[child + 1], &h->nodes[child]))
+			child++;
+		if (!precedes(&h->nodes[child], &last))
+			break;
+		h->nodes[i] = h->nodes[child];
+		i = child;
+	}
+	if (h->size > 0)
+		h->nodes[i] = last;
+
+	return top;
+}
+
+//Returns element with the smallest key without removing it
+pcbptr heap_peek(heap h) {
+	return h.size == 0 ? NULL : h.nodes[0].process;
+}
+
+//Returns the smallest key
+int heap_peek_key(heap h) {
+	return h.nodes[0].key;
+}
+
+//Returns true if heap is empty. False otherwise
+bool isEmptyHeap(heap h) {
+	return h.size == 0;
+}
+
+//Initializes 'dest' as a copy of 'src'
+void copy_heap(heap * dest, heap src) {
+	init_heap(dest);
+	if (src.size == 0)
+		return;
+
+	dest->nodes = malloc(sizeof(struct HeapNode) * src.size);
+	if (dest->nodes == NULL) {
+		printf("ERROR - Could not copy heap\n");
+		exit(EXIT_FAILURE);
+	}
+	memcpy(dest->nodes, src.nodes, sizeof(struct HeapNode) * src.size);
+	dest->size = src.size;
+	dest->capacity = src.size;
+	dest->counter = src.counter;
+}
+
+//Frees the heap's array
+void free_heap(heap * h) {
+	free(h->nodes);
+	init_heap(h);
+}
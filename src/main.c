@@ -7,14 +7,51 @@
 
 #include <stdio.h>
 #include <stdlib.h>
+#include <unistd.h> //For getopt
 #include "../inc/process_mgmt.h"
+#include "../inc/cluster.h"
 
 int main(int argc, char* argv[]) {
 	char * fileName = NULL;
+	char * workerAddress = NULL;				//Address to listen on when running as a worker
+	char * workers[CLUSTER_MAX_WORKERS];		//Addresses of workers when running as a coordinator
+	int numWorkers = 0;
+	int option;
+
+	/*Parse options*/
+	while((option = getopt(argc, argv, "ew:c:")) != -1) {
+		switch(option) {
+			case 'e':	//Earliest-deadline-first scheduling for real-time processes
+				set_edf_mode(true);
+				break;
+			case 'w':	//Run as a worker that receives processes from a coordinator
+				workerAddress = optarg;
+				break;
+			case 'c':	//Run as a coordinator that forwards processes to this worker
+				if(numWorkers == CLUSTER_MAX_WORKERS) {
+					printf("ERROR - At most %d workers are supported\n", CLUSTER_MAX_WORKERS);
+					exit(EXIT_FAILURE);
+				}
+				workers[numWorkers++] = optarg;
+				break;
+			default:
+				printf("Usage: %s [-e] <dispatch file>\n"
+					   "       %s [-e] -w <address>\n"
+					   "       %s -c <worker address> [-c <worker address> ...] <dispatch file>\n",
+					   argv[0], argv[0], argv[0]);
+				exit(EXIT_FAILURE);
+		}
+	}
+
+	if(workerAddress != NULL) {
+		start_worker(workerAddress);
+		return 0;
+	}
+
 	/* If an argument (file name) is passed, then set the file name. Otherwise,
 	   display contents of the readme file and exit.*/
-	if(argc > 1)
-		fileName = argv[1];
+	if(optind < argc)
+		fileName = argv[optind];
 	else {
 		unsigned int SIZE = 2048;
 		char* buffer = malloc(SIZE);
@@ -36,6 +73,12 @@ int main(int argc, char* argv[]) {
 		exit(EXIT_FAILURE);
 	}
 
+	if(numWorkers > 0) {
+		start_coordinator(file, workers, numWorkers);
+		fclose(file);
+		return 0;
+	}
+
 	init_dispatcher(file);
 	fclose(file);
 	start_dispatcher(); //Run the dispatcher.
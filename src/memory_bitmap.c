@@ -0,0 +1,232 @@
+/*********************************************************************************
+ * File: memory_bitmap.c
+ * Description: Bitmap implementation of the memory management functions.
+   Each bit of the bitmap tracks one page and is set while the page is free.
+   Runs of free pages are found a 64-bit word at a time: full and empty words are
+   skipped whole, and runs inside a word are found by repeatedly ANDing the word
+   with shifted copies of itself. Blocks are kept in a table indexed by their first
+   page, so allocating and freeing never call malloc.
+**********************************************************************************/
+
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include "../inc/memory_bitmap.h"
+#include "../inc/arena.h"
+
+#define DEBUG_MEMORY false	//Debug flag specific to this file
+#define ALL_FREE UINT64_MAX	//Word in which every page is free
+
+int mRemainingMem = TOTAL_MEM;		//Amount of free memory in the system
+bool mInitialized = false;			//True once the bitmap has been initialized
+uint64_t mFreePages[MEM_WORDS];		//Bitmap of free pages
+long mFirstFreeWord = 0;			//No word before this one has a free page
+Mab mBlocks[MEM_PAGES];				//Allocated blocks, indexed by their first page
+
+//Marks every page as free. Internal to this module.
+void bitmap_init() {
+	long word;
+	for (word = 0; word < MEM_WORDS; word++)
+		mFreePages[word] = ALL_FREE;
+	/*Pages past the end of memory are never free*/
+	if (MEM_PAGES % MEM_WORD_BITS != 0)
+		mFreePages[MEM_WORDS - 1] = (1ull << (MEM_PAGES % MEM_WORD_BITS)) - 1;
+	mFirstFreeWord = 0;
+	mInitialized = true;
+}
+
+//Sets (free = true) or clears the bits of 'count' pages starting at 'page'. Internal to this module.
+void bitmap_mark(long page, long count, bool free) {
+	while (count > 0) {
+		long word = page / MEM_WORD_BITS;
+		int bit = page % MEM_WORD_BITS;
+		int bits = count < MEM_WORD_BITS - bit ? count : MEM_WORD_BITS - bit;
+		uint64_t mask = (bits == MEM_WORD_BITS ? ALL_FREE : ((1ull << bits) - 1)) << bit;
+
+		if (free)
+			mFreePages[word] |= mask;
+		else
+			mFreePages[word] &= ~mask;
+		page += bits;
+		count -= bits;
+	}
+}
+
+//Returns the first page of the first run of 'pages' free pages. Returns -1 if there is none. Internal to this module.
+long bitmap_find(long pages) {
+	long run = 0;		//Number of free pages at the end of the words scanned so far
+	long start = 0;		//First page of that run
+	long word;
+
+	for (word = mFirstFreeWord; word < MEM_WORDS; word++) {
+		uint64_t bits = mFreePages[word];
+
+		if (bits == ALL_FREE) {
+			if (run == 0)
+				start = word * MEM_WORD_BITS;
+			run += MEM_WORD_BITS;
+			if (run >= pages)
+				return start;
+			continue;
+		}
+		if (bits == 0) {
+			run = 0;
+			continue;
+		}
+
+		/*Free pages at the start of the word extend the run from the previous words*/
+		int low = __builtin_ctzll(~bits);
+		if (run == 0)
+			start = word * MEM_WORD_BITS;
+		if (run + low >= pages)
+			return start;
+
+		/*A run that fits inside the word. After the loop, bit i is set if pages i to i + pages - 1 are free.*/
+		if (pages < MEM_WORD_BITS) {
+			uint64_t fits = bits;
+			long length = 1;
+			while (length < pages && fits != 0) {
+				long shift = length < pages - length ? length : pages - length;
+				fits &= fits >> shift;
+				length += shift;
+			}
+			if (fits != 0)
+				return word * MEM_WORD_BITS + __builtin_ctzll(fits);
+		}
+
+		/*Free pages at the end of the word start a new run*/
+		run = __builtin_clzll(~bits);
+		start = (word + 1) * MEM_WORD_BITS - run;
+	}
+	return -1;
+}
+
+//Returns the first page of the run of free pages that ends just before 'page'. Internal to this module.
+long bitmap_run_start(long page) {
+	while (page > 0) {
+		int bit = (page - 1) % MEM_WORD_BITS;
+		uint64_t below = mFreePages[(page - 1) / MEM_WORD_BITS] << (MEM_WORD_BITS - 1 - bit);	//Page - 1 is the top bit
+		if (~below != 0)
+			return page - __builtin_clzll(~below);
+		page -= bit + 1;
+	}
+	return 0;
+}
+
+//Returns the page after the run of free pages that starts at 'page'. Internal to this module.
+long bitmap_run_end(long page) {
+	while (page < MEM_PAGES) {
+		int bit = page % MEM_WORD_BITS;
+		uint64_t used = ~(mFreePages[page / MEM_WORD_BITS] >> bit);	//The bits shifted in count as used
+		int length = used == 0 ? MEM_WORD_BITS : __builtin_ctzll(used);
+		page += length;
+		if (bit + length < MEM_WORD_BITS)
+			break;
+	}
+	return page < MEM_PAGES ? page : MEM_PAGES;
+}
+
+//Returns the number of pages needed for 'size' MB. Internal to this module.
+long pages_needed(int size) {
+	long pages = ((long)size + MEM_PAGE_SIZE - 1) / MEM_PAGE_SIZE;
+	return pages > 0 ? pages : 1;
+}
+
+//Returns the amount of free memory available in the system
+int get_remaining_mem() {
+	return mRemainingMem;
+}
+
+//Returns the size of the largest free memory block
+int mem_largest_block() {
+	long largest = 0;
+	long run = 0;
+	long word;
+
+	if (!mInitialized)
+		bitmap_init();
+
+	for (word = 0; word < MEM_WORDS; word++) {
+		uint64_t bits = mFreePages[word];
+		int bit = 0;
+		/*Walk the runs of free and allocated pages in the word*/
+		while (bit < MEM_WORD_BITS) {
+			uint64_t rest = bits >> bit;
+			int length;
+			if (rest & 1) {
+				length = ~rest == 0 ? MEM_WORD_BITS - bit : __builtin_ctzll(~rest);	//~rest is 0 for a free word when bit == 0
+				run += length;
+				if (run > largest)
+					largest = run;
+			} else {
+				length = rest == 0 ? MEM_WORD_BITS - bit : __builtin_ctzll(rest);
+				run = 0;
+			}
+			bit += length;
+		}
+	}
+	return largest * MEM_PAGE_SIZE;
+}
+
+bool mem_check(int size) {
+	if (!mInitialized)
+		bitmap_init();
+	return size <= mRemainingMem && bitmap_find(pages_needed(size)) >= 0;
+}
+
+//Allocate memory block
+mabptr mem_alloc(int size) {
+	if (!mInitialized)
+		bitmap_init();
+
+	/*Make sure there is enough memory left in the system*/
+	long pages = pages_needed(size);
+	if (mRemainingMem < pages * MEM_PAGE_SIZE) {
+		if (DEBUG)
+			printf("\tSystem out of memory!!\n");
+		return NULL;
+	}
+
+	long page = bitmap_find(pages);
+	if (page < 0)
+		return NULL;
+
+	bitmap_mark(page, pages, false);
+	while (mFirstFreeWord < MEM_WORDS && mFreePages[mFirstFreeWord] == 0)
+		mFirstFreeWord++;
+
+	mabptr memory = &mBlocks[page];
+	memory->offset = page * MEM_PAGE_SIZE;
+	memory->size = pages * MEM_PAGE_SIZE;
+	memory->allocated = true;
+	memory->next = NULL;
+	memory->previous = NULL;
+	mRemainingMem -= memory->size;
+
+	if (DEBUG_MEMORY)
+		printf("\tAllocated memory: offset = %d  mem = %dMB\n", memory->offset, memory->size);
+	return memory;
+}
+
+//Free memory block
+void mem_free(mabptr memory) {
+	if (memory == NULL || !memory->allocated)
+		return;
+
+	if (DEBUG_MEMORY)
+		printf("\tFreed memory: offset = %d  mem = %dMB\n", memory->offset, memory->size);
+
+	long page = memory->offset / MEM_PAGE_SIZE;
+	bitmap_mark(page, memory->size / MEM_PAGE_SIZE, true);
+	if (page / MEM_WORD_BITS < mFirstFreeWord)
+		mFirstFreeWord = page / MEM_WORD_BITS;
+
+	memory->allocated = false;
+	mRemainingMem += memory->size;
+
+	/*Give the pages of the whole free run back to the system, including hugepages that
+	  were shared with neighbouring blocks that are already free*/
+	long first = bitmap_run_start(page);
+	long last = bitmap_run_end(page + memory->size / MEM_PAGE_SIZE);
+	arena_release(first * MEM_PAGE_SIZE, (last - first) * MEM_PAGE_SIZE);
+}
@@ -7,11 +7,12 @@
 #include <stdio.h>
 #include <stdlib.h>
 #include "../inc/memory_mgmt.h"
+#include "../inc/arena.h"
 #include "../inc/process_mgmt.h"
 #include "../inc/queue.h"
 
 #define DEBUG_MEMORY false	//Debug flag specific to this file
-#define TOTAL_MEMORY 1024	//Total amount of memory in the system
+#define TOTAL_MEMORY TOTAL_MEM	//Total amount of memory in the system
 
 int mRemainingMem = TOTAL_MEMORY;	//Amount of free memory in the system
 mabptr mFirstBlock = NULL;			//Pointer to the first block in memory
@@ -28,6 +29,24 @@ mabptr getNewMemBlock() {
 	return memBlock;
 }
 
+//Returns the amount of free memory available in the system
+int get_remaining_mem() {
+	return mRemainingMem;
+}
+
+//Returns the size of the largest free memory block
+int mem_largest_block() {
+	if (mFirstBlock == NULL)	//Memory has not been initialized, so it is a single free block
+		return mRemainingMem;
+
+	int largest = 0;
+	mabptr head;
+	for (head = mFirstBlock; head != NULL; head = head->next)
+		if (!head->allocated && head->size > largest)
+			largest = head->size;
+	return largest;
+}
+
 bool mem_check(int size) {
 	bool canBeAllocated = false;
 
@@ -127,6 +146,10 @@ void mem_free(mabptr memory){
 	if(memory->next != NULL && !memory->next->allocated) {
 		mem_merge(memory, memory->next);
 	}
+
+	/*Give the pages of the whole free block back to the system, including hugepages that
+	  were shared with the neighbours that are now free*/
+	arena_release(memory->offset, memory->size);
 }
 
 //Splits block into two. Returns pointer to leftover block
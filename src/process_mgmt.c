@@ -3,6 +3,7 @@
  * Description: Defines functions to manage processes
  *********************************************************/
  
+#include <limits.h>
 #include <signal.h>
 #include <stdio.h>
 #include <stdlib.h>
@@ -11,6 +12,10 @@
 #include "../inc/process_mgmt.h"
 #include "../inc/memory_mgmt.h"
 #include "../inc/queue.h"
+#include "../inc/heap.h"
+#include "../inc/wheel.h"
+#include "../inc/arena.h"
+#include "../inc/profile.h"
 
 #define DEBUG_PROCESS false						//Debug flag specific to this file
 
@@ -25,15 +30,27 @@ int mScanners = NUM_SCANNERS;					//Number of free scanners
 int mModems = NUM_MODEMS;						//Number of free modems
 int mCDs = NUM_CDS;								//Number of free CD drives
 
-queue mInput;	//Input queue
+timer_wheel mInput;	//Input wheel. Holds processes until their arrival time.
 queue mJobs;	//User job queue
 
 queue mFcfs;	/*First-come-first-serve queue used for real time (priority = 0) processes
 				  This queue must be empty before the other queues are activated.*/
+heap mEdf;		/*Earliest-deadline-first heap used instead of mFcfs for real time processes when EDF mode
+				  is enabled. Processes without a deadline are ordered after all processes with one.*/
 queue mLevel1;	//High priority feedback queue (priority = 1)
 queue mLevel2;	//Medium priority feedback queue (priority = 2)
 queue mLevel3;  //Low priority feedback queue (priority = 3)
 
+bool mEdfMode = false;			//True if real-time processes are scheduled earliest-deadline-first
+
+int mDeadlinesMet = 0;			//Number of processes that finished by their deadline
+int mDeadlinesMissed = 0;		//Number of processes that finished after their deadline
+int mDeadlinesRejected = 0;		//Number of real-time processes rejected by EDF admission control
+
+int mReceived = 0;				//Number of processes added to the input wheel
+int mCompleted = 0;				//Number of processes that ran to completion
+int mRejected = 0;				//Number of processes that were not admitted into the system
+
 pcbptr mActiveProcess = NULL;	//Currently active process. Set to NULL after running process is terminated.
 
 mabptr mReservedMem = NULL;		//Memory reserved for real-time processes.
@@ -69,115 +86,174 @@ void rsrc_free(pcbptr process) {
 
 //Starts the process dispatcher
 void start_dispatcher() {
+	prof_init();
 	do {
-		mabptr allocatedMem = NULL; //Pointer to memory that will be allocated to a process.
+		dispatch_tick();
+		wait_quantum();
+	} while (!is_dispatcher_idle());	//Loop continues until all queues are empty and there is no process running
+	report_deadlines();
+}
 
-		/*Unload pending processes from the input queue*/
-		while (mInput.front != NULL && mInput.front->arrival_time <= mDispatcher_timer) {
-			if(DEBUG)
-				printf("New process added to system\n");
-
-			/*Remove process from input queue and add it to the user job queue if it is a user job.
-			  Otherwise, add it to the real-time processes queue.*/
-			pcbptr newProcess = dequeue(&mInput);
-			/*If the process is larger than the total available memory, it is not admitted into the system*/
-			if(newProcess->priority != 0) {
-				/*If job requires more memory than the system has in total, display appropriate message and
-				  do not admit the process.*/
-				if (newProcess->info[memory_alloc] > mTotalMem) {
-					printf("\nERROR - Job memory request(%dMB) exceeds total memory(%dMB) - job deleted\n\n",
-							newProcess->info[memory_alloc], mTotalMem);
-				} else if (newProcess->info[num_printers] > NUM_PRINTERS ||
-							newProcess->info[num_scanners] > NUM_SCANNERS ||
-							newProcess->info[num_modems] > NUM_MODEMS ||
-							newProcess->info[num_cds] > NUM_CDS) {
-					printf("\nERROR - Job demands too many resources - job deleted\n\n");
-				}
-				else {
-					enqueue(&mJobs, newProcess);
-				}
+//Runs one pass of the dispatcher: admits arrived processes, allocates their resources and schedules a process.
+void dispatch_tick() {
+	PROF_BEGIN(loopStart);
+	HOSTD_PROBE1(loop_begin, mDispatcher_timer);
+	mabptr allocatedMem = NULL; //Pointer to memory that will be allocated to a process.
+
+	/*Unload pending processes from the input wheel*/
+	pcbptr newProcess = NULL;
+	wheel_advance(&mInput, mDispatcher_timer);
+	while ((newProcess = wheel_pop_due(&mInput)) != NULL) {
+		if(DEBUG)
+			printf("New process added to system\n");
+
+		/*Add process removed from the input wheel to the user job queue if it is a user job.
+		  Otherwise, add it to the real-time processes queue.*/
+		/*If the process is larger than the total available memory, it is not admitted into the system*/
+		if(newProcess->priority != 0) {
+			/*If job requires more memory than the system has in total, display appropriate message and
+			  do not admit the process.*/
+			if (newProcess->info[memory_alloc] > mTotalMem) {
+				printf("\nERROR - Job memory request(%dMB) exceeds total memory(%dMB) - job deleted\n\n",
+						newProcess->info[memory_alloc], mTotalMem);
+				mRejected++;
+			} else if (newProcess->info[num_printers] > NUM_PRINTERS ||
+						newProcess->info[num_scanners] > NUM_SCANNERS ||
+						newProcess->info[num_modems] > NUM_MODEMS ||
+						newProcess->info[num_cds] > NUM_CDS) {
+				printf("\nERROR - Job demands too many resources - job deleted\n\n");
+				mRejected++;
 			}
 			else {
-				/*If job requires more memory than the system has in total, display appropriate message and
-				  do not admit the process.*/
-				if (newProcess->info[memory_alloc] > RESERVED_MEM) {
-					printf("\nERROR - Real-time memory request(%dMB) exceeds reserved memory(%dMB) - job deleted\n\n",
-							newProcess->info[memory_alloc], RESERVED_MEM);
-				} else if (newProcess->info[num_printers] > 0 ||
-						newProcess->info[num_scanners] > 0 ||
-						newProcess->info[num_modems] > 0 ||
-						newProcess->info[num_cds] > 0) {
-					printf("\nERROR - Real-time job not allowed I/O resources - job deleted\n\n");
+				enqueue(&mJobs, newProcess);
+			}
+		}
+		else {
+			/*If job requires more memory than the system has in total, display appropriate message and
+			  do not admit the process.*/
+			if (newProcess->info[memory_alloc] > RESERVED_MEM) {
+				printf("\nERROR - Real-time memory request(%dMB) exceeds reserved memory(%dMB) - job deleted\n\n",
+						newProcess->info[memory_alloc], RESERVED_MEM);
+				mRejected++;
+			} else if (newProcess->info[num_printers] > 0 ||
+					newProcess->info[num_scanners] > 0 ||
+					newProcess->info[num_modems] > 0 ||
+					newProcess->info[num_cds] > 0) {
+				printf("\nERROR - Real-time job not allowed I/O resources - job deleted\n\n");
+				mRejected++;
+			}
+			else if (mEdfMode && !edf_admissible(newProcess)) {
+				printf("\nERROR - Real-time job cannot meet its deadline(%d) - job deleted\n\n",
+						newProcess->info[deadline]);
+				mDeadlinesRejected++;
+				mRejected++;
+			}
+			else
+				placeInQueue(newProcess);
+		}
+	}
+
+	/*Unload pending processes from user jobs queue while the memory can be allocated to them.*/
+	while(mJobs.front != NULL &&
+			mem_check(mJobs.front->info[memory_alloc]) &&
+			 rsrc_chk(mJobs.front->info[num_printers], mJobs.front->info[num_scanners],
+					  mJobs.front->info[num_modems], mJobs.front->info[num_cds])) {
+		/*Allocate memory to process and place it in appropriate queue based on its priority level.*/
+		HOSTD_PROBE1(mem_alloc_begin, mJobs.front->info[memory_alloc]);
+		PROF_BEGIN(allocStart);
+		allocatedMem = mem_alloc( mJobs.front->info[memory_alloc]);
+		PROF_END(PROF_MEM_ALLOC, allocStart);
+		HOSTD_PROBE2(mem_alloc_end, allocatedMem->offset, allocatedMem->size);
+		pcbptr process = dequeue(&mJobs);
+		process->memory = allocatedMem;
+		rsrc_alloc(process, process->info[num_printers], process->info[num_scanners],
+				process->info[num_modems], process->info[num_cds]);
+		placeInQueue(process);
+	}
+
+	/*If a process is running*/
+	if (mActiveProcess != NULL) {
+		mActiveProcess->remaining_cpu_time--;
+		/*If process is done executing, terminate it and free its resources.*/
+		if(mActiveProcess->remaining_cpu_time == 0) {
+			kill_process(mActiveProcess);
+			mCompleted++;
+			/*Record whether the process finished by its deadline*/
+			if(mActiveProcess->deadline > 0) {
+				if(mDispatcher_timer > mActiveProcess->deadline) {
+					printf("\nWARNING - Process %d missed its deadline(%d) by %d\n\n", mActiveProcess->pid,
+							mActiveProcess->info[deadline], mDispatcher_timer - mActiveProcess->deadline);
+					mDeadlinesMissed++;
 				}
 				else
-					enqueue(&mFcfs, newProcess);
+					mDeadlinesMet++;
 			}
+			free_process_pointers(mActiveProcess);
+			mActiveProcess = NULL;		//Set active process to NULL to indicate there is no currently running process
+		} 
+		else if(mActiveProcess->priority > 0 && !areEmptyQueues()) {
+			/*If active process is not a real-time process and there are processes in other queues, 
+			  then suspend the active process*/
+			suspend_process(mActiveProcess);
+			/*If the process's priority is < 3, reduce its priority (higher # = lower priority)
+			  and send it to its appropriate queue. */
+			if(mActiveProcess->priority < 3)
+				mActiveProcess->priority++;
+			placeInQueue(mActiveProcess);
+			mActiveProcess = NULL;	//Set active process to NULL to indicate there is no currently running process
 		}
+	}	//End if
+	if(mActiveProcess == NULL && !areEmptyQueues()) {
+		/*Run the a process from the highest priority queue that isn't empty*/
+		if (!isEmptyHeap(mEdf))
+			mActiveProcess = heap_pop(&mEdf);
+		else if (!isEmptyQueue(mFcfs))
+			mActiveProcess = dequeue(&mFcfs);
+		else if (!isEmptyQueue(mLevel1))
+			mActiveProcess = dequeue(&mLevel1);
+		else if (!isEmptyQueue(mLevel2))
+			mActiveProcess = dequeue(&mLevel2);
+		else if (!isEmptyQueue(mLevel3))
+			mActiveProcess = dequeue(&mLevel3);
+
+		if(mActiveProcess->priority == 0)
+			mActiveProcess->memory = mReservedMem;
+
+		/*If process is suspended, restart it. Otherwise, start it.*/
+		if(mActiveProcess->status == SUSPENDED)
+			restart_process(mActiveProcess);
+		else
+			start_process(mActiveProcess);
+	} //End if		
+	HOSTD_PROBE1(loop_end, mDispatcher_timer);
+	PROF_END(PROF_LOOP, loopStart);
+	prof_poll();
+}
 
-		/*Unload pending processes from user jobs queue while the memory can be allocated to them.*/
-		while(mJobs.front != NULL &&
-				mem_check(mJobs.front->info[memory_alloc]) &&
-				 rsrc_chk(mJobs.front->info[num_printers], mJobs.front->info[num_scanners],
-						  mJobs.front->info[num_modems], mJobs.front->info[num_cds])) {
-			/*Allocate memory to process and place it in appropriate queue based on its priority level.*/
-			allocatedMem = mem_alloc( mJobs.front->info[memory_alloc]);
-			pcbptr process = dequeue(&mJobs);
-			process->memory = allocatedMem;
-			rsrc_alloc(process, process->info[num_printers], process->info[num_scanners],
-					process->info[num_modems], process->info[num_cds]);
-			placeInQueue(process);
-		}
+//Sleeps for one quantum and advances the dispatcher timer
+void wait_quantum() {
+	/*Sleep for the whole quantum even if a signal interrupts the sleep*/
+	unsigned int remaining = mQUANTUM;
+	while((remaining = sleep(remaining)) > 0);
+	mDispatcher_timer += mQUANTUM;
+}
 
-		/*If a process is running*/
-		if (mActiveProcess != NULL) {
-			mActiveProcess->remaining_cpu_time--;
-			/*If process is done executing, terminate it and free its resources.*/
-			if(mActiveProcess->remaining_cpu_time == 0) {
-				kill_process(mActiveProcess);
-				free_process_pointers(mActiveProcess);
-				mActiveProcess = NULL;		//Set active process to NULL to indicate there is no currently running process
-			} 
-			else if(mActiveProcess->priority > 0 && !areEmptyQueues()) {
-				/*If active process is not a real-time process and there are processes in other queues, 
-				  then suspend the active process*/
-				suspend_process(mActiveProcess);
-				/*If the process's priority is < 3, reduce its priority (higher # = lower priority)
-				  and send it to its appropriate queue. */
-				if(mActiveProcess->priority < 3)
-					mActiveProcess->priority++;
-				placeInQueue(mActiveProcess);
-				mActiveProcess = NULL;	//Set active process to NULL to indicate there is no currently running process
-			}
-		}	//End if
-		if(mActiveProcess == NULL && !areEmptyQueues()) {
-			/*Run the a process from the highest priority queue that isn't empty*/
-			if (!isEmptyQueue(mFcfs))
-				mActiveProcess = dequeue(&mFcfs);
-			else if (!isEmptyQueue(mLevel1))
-				mActiveProcess = dequeue(&mLevel1);
-			else if (!isEmptyQueue(mLevel2))
-				mActiveProcess = dequeue(&mLevel2);
-			else if (!isEmptyQueue(mLevel3))
-				mActiveProcess = dequeue(&mLevel3);
-
-			if(mActiveProcess->priority == 0)
-				mActiveProcess->memory = mReservedMem;
-
-			/*If process is suspended, restart it. Otherwise, start it.*/
-			if(mActiveProcess->status == SUSPENDED)
-				restart_process(mActiveProcess);
-			else
-				start_process(mActiveProcess);
-		} //End if		
-		sleep(mQUANTUM);
-		mDispatcher_timer += mQUANTUM;
-	} while (!areEmptyQueues() || mActiveProcess != NULL ||		/*Loop continues until all queues are empty and there is no process running*/
-				!isEmptyQueue(mJobs) || !isEmptyQueue(mInput));	//End while
+//Returns true if there are no processes left in the system
+bool is_dispatcher_idle() {
+	return areEmptyQueues() && mActiveProcess == NULL &&
+			isEmptyQueue(mJobs) && isEmptyWheel(&mInput);
+}
+
+//Prints deadline statistics if any process had a deadline
+void report_deadlines() {
+	if(mDeadlinesMet + mDeadlinesMissed + mDeadlinesRejected > 0)
+		printf("\nDeadlines: %d met, %d missed, %d rejected\n",
+				mDeadlinesMet, mDeadlinesMissed, mDeadlinesRejected);
 }
 
 //Returns true if all queues (excluding input queue) are empty)
 bool areEmptyQueues() {
-	return isEmptyQueue(mFcfs) && isEmptyQueue(mLevel1) &&
+	return isEmptyQueue(mFcfs) && isEmptyHeap(mEdf) && isEmptyQueue(mLevel1) &&
 		isEmptyQueue(mLevel2) && isEmptyQueue(mLevel3);
 }
 
@@ -187,6 +263,8 @@ pcbptr create_pcb() {
 	control_block->pid = 0;
 	control_block->arrival_time = 0;
 	control_block->remaining_cpu_time = 0;
+	control_block->status = NOT_STARTED;
+	control_block->memory = NULL;
 	control_block->next = NULL;
 	
 	return control_block;
@@ -194,14 +272,26 @@ pcbptr create_pcb() {
  
 //Starts process
 void start_process(pcbptr process) {
+	HOSTD_PROBE0(start_begin);
+	fflush(stdout);	//Otherwise the child inherits buffered output and prints it again if exec fails
+	PROF_EXEC_BEGIN(forkStart);
 	int pid = fork();	
-	if(pid < 0)										//Error
+	if(pid < 0) {									//Error
 		printf("\tError creating process\n");
+		PROF_EXEC_CANCEL(forkStart);
+	}
 	else if (pid == 0) {							//Child executing
+		/*Hand the child its memory block. Real-time processes share the reserved block and only get what they asked for.*/
+		arena_export(process->memory->offset,
+				process->priority == 0 ? process->info[memory_alloc] : process->memory->size);
 		execvp(process->args[0], process->args);
 		printf("\tError executing process \"%s\"   %d\n", process->args[0], getpid());
+		fflush(stdout);
+		_exit(EXIT_FAILURE);	//Do not return into a copy of the dispatcher
 	}
 	else {											//Parent executing
+		PROF_EXEC_END(PROF_START, forkStart);
+		HOSTD_PROBE1(start_end, pid);
 		process->pid = pid;
 		process->status = RUNNING;
 		if(DEBUG)
@@ -228,6 +318,8 @@ void restart_process(pcbptr process) {
 
 //Suspends process
 void suspend_process(pcbptr process) {
+	HOSTD_PROBE1(suspend_begin, process->pid);
+	PROF_BEGIN(suspendStart);
 	if(kill(process->pid, SIGTSTP) != 0) {
 		printf("Suspend of %d failed.\n", process->pid);
 		return;
@@ -236,11 +328,15 @@ void suspend_process(pcbptr process) {
 		printf("Process %d suspended.\n", process->pid);		
 	
 	waitpid(process->pid, &status, WUNTRACED); //Wait for process to be stopped before continuing execution
+	PROF_END(PROF_SUSPEND, suspendStart);
+	HOSTD_PROBE1(suspend_end, process->pid);
 	process->status = SUSPENDED; 
 }
 
 ///Terminates process and frees its resources
 void kill_process(pcbptr process) {
+	HOSTD_PROBE1(kill_begin, process->pid);
+	PROF_BEGIN(killStart);
 	if(kill(process->pid, SIGINT) != 0) {
 		printf("Terminate of %d failed.\n", process->pid);
 		return;
@@ -249,12 +345,20 @@ void kill_process(pcbptr process) {
 		printf("Process %d terminated.\n", process->pid);
 		
 	waitpid(process->pid, &status, WUNTRACED); //Wait for process to be terminated before continuing execution
+	PROF_END(PROF_KILL, killStart);
+	HOSTD_PROBE1(kill_end, process->pid);
 
 	/*Free the resources for user job*/
 	if(process->priority != 0) {
+		HOSTD_PROBE2(mem_free_begin, process->memory->offset, process->memory->size);
+		PROF_BEGIN(freeStart);
 		mem_free(process->memory);
+		PROF_END(PROF_MEM_FREE, freeStart);
+		HOSTD_PROBE0(mem_free_end);
 		rsrc_free(process);
 	}
+	else	//Real-time processes share the reserved memory, so clear the part this one used for the next one
+		arena_release(process->memory->offset, process->info[memory_alloc]);
 	process->status = TERMINATED;
 }
 
@@ -264,11 +368,16 @@ void init_process(pcbptr process, int * processInfo) {
 	process->arrival_time = processInfo[arrival_time];
 	process->remaining_cpu_time = processInfo[cpu_time];
 	process->priority = processInfo[priority];
+	/*The deadline in the dispatch file is relative to the arrival time*/
+	process->deadline = processInfo[deadline] > 0 ? processInfo[arrival_time] + processInfo[deadline] : 0;
 	process->info = processInfo;
 }
 
-//Initializes dispatcher
+//Initializes dispatcher. If file is NULL, the dispatcher starts without processes.
 void init_dispatcher(FILE *file) {
+	if(!arena_init(TOTAL_MEM))
+		printf("WARNING - Could not create shared memory arena - processes will not receive memory\n");
+
 	if(mReservedMem == NULL) {
 		mReservedMem = mem_alloc(RESERVED_MEM);
 		mReservedMem->allocated = true;
@@ -277,29 +386,58 @@ void init_dispatcher(FILE *file) {
 	mDispatcher_timer = 0;
 	mActiveProcess = NULL;
 	/*Initialize queues*/
-	init_queue(&mInput);
+	init_wheel(&mInput);
 	init_queue(&mJobs);
 	init_queue(&mFcfs);
+	init_heap(&mEdf);
 	init_queue(&mLevel1);
 	init_queue(&mLevel2);
 	init_queue(&mLevel3);
 
-	/*Populate input queue.*/
-	while (!feof(file)) {
+	/*Populate input wheel. The dispatch file does not need to be sorted by arrival time.*/
+	while (file != NULL && !feof(file)) {
 		int *processInfo = readInfo(file);	
 		if (processInfo == NULL)
 			continue;			
-		pcbptr process = create_pcb();
-		init_process(process, processInfo);		
-		enqueue(&mInput, process);
+		add_process(processInfo);
 	}
 }
 
+//Adds a process to the input wheel. It is admitted into the system at its arrival time.
+void add_process(int * processInfo) {
+	pcbptr process = create_pcb();
+	init_process(process, processInfo);
+	wheel_insert(&mInput, process);
+	mReceived++;
+}
+
+//Returns the current time of the dispatcher
+int get_dispatcher_timer() {
+	return mDispatcher_timer;
+}
+
+//Fills in a summary of the dispatcher's memory and resources
+void get_dispatcher_status(dispatcher_status * status) {
+	status->timer = mDispatcher_timer;
+	status->free_mem = get_remaining_mem();
+	status->largest_block = mem_largest_block();
+	status->printers = mPrinters;
+	status->scanners = mScanners;
+	status->modems = mModems;
+	status->cds = mCDs;
+	status->received = mReceived;
+	status->completed = mCompleted;
+	status->rejected = mRejected;
+}
+
 //Adds process to appropriate queue based on its priority level.
 void placeInQueue(pcbptr process) {
 	switch(process->priority) {
 		case 0:
-			enqueue(&mFcfs, process);
+			if(mEdfMode)
+				heap_push(&mEdf, process->deadline > 0 ? process->deadline : INT_MAX, process);
+			else
+				enqueue(&mFcfs, process);
 			break;
 		case 1:
 			enqueue(&mLevel1, process);
@@ -342,3 +480,33 @@ bool rsrc_alloc (pcbptr process, int printers, int scanners, int modems, int cds
 
 	return true;
 }
+
+//Schedules real-time processes earliest-deadline-first instead of first-come-first-serve.
+void set_edf_mode(bool enabled) {
+	mEdfMode = enabled;
+}
+
+/*Returns true if the real-time process can be admitted without any real-time process missing its deadline.
+  Real-time processes run to completion, so the pending processes are simulated in deadline order
+  starting from the time the running real-time process (if any) finishes.*/
+bool edf_admissible(pcbptr process) {
+	int time = mDispatcher_timer;	//Time at which the next real-time process can start
+	if(mActiveProcess != NULL && mActiveProcess->priority == 0)
+		time += mActiveProcess->remaining_cpu_time - 1;
+
+	heap pending;
+	copy_heap(&pending, mEdf);
+	heap_push(&pending, process->deadline > 0 ? process->deadline : INT_MAX, process);
+
+	bool schedulable = true;
+	while(!isEmptyHeap(pending)) {
+		pcbptr next = heap_pop(&pending);
+		time += next->remaining_cpu_time;
+		if(next->deadline > 0 && time > next->deadline) {
+			schedulable = false;
+			break;
+		}
+	}
+	free_heap(&pending);
+	return schedulable;
+}
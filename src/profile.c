@@ -0,0 +1,162 @@
+/*********************************************************
+ * File: profile.c
+ * Description: Dispatcher overhead profiler. Samples are kept in
+   HDR-style log-linear histograms: values below 64ns have their own
+   bucket and every power of two above that is split into 32 buckets,
+   so any recorded value is within about 3% of its bucket. Updates use
+   relaxed atomics and never block.
+ *********************************************************/
+
+#define _GNU_SOURCE	//For pipe2
+
+#include "../inc/profile.h"
+
+#ifdef HOSTD_PROFILE
+
+#include <fcntl.h>
+#include <signal.h>
+#include <stdbool.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+#include <unistd.h>
+
+#define SUB_BITS 5								//log2 of the number of buckets per power of two
+#define SUB_BUCKETS (1 << SUB_BITS)
+#define NUM_BUCKETS ((64 - SUB_BITS + 1) * SUB_BUCKETS)
+
+/*Latency histogram*/
+struct Histogram {
+	uint64_t count;					//Number of samples
+	uint64_t total;					//Sum of all samples
+	uint64_t max;					//Largest sample
+	uint64_t buckets[NUM_BUCKETS];	//Number of samples in each bucket
+};
+
+const char *mEventNames[PROF_EVENTS] = {"fork/exec", "suspend", "kill", "mem_alloc", "mem_free", "loop pass"};
+struct Histogram mHistograms[PROF_EVENTS];
+volatile sig_atomic_t mDumpRequested = 0;	//Set by the SIGUSR1 handler
+
+//Returns the bucket a value belongs to. Internal to this module.
+int bucket_index(uint64_t value) {
+	if (value < 2 * SUB_BUCKETS)
+		return value;
+	int shift = 63 - __builtin_clzll(value) - SUB_BITS;	//Leaves SUB_BITS + 1 significant bits
+	return (shift + 1) * SUB_BUCKETS + (int)(value >> shift) - SUB_BUCKETS;
+}
+
+//Returns the largest value that falls in a bucket. Internal to this module.
+uint64_t bucket_max(int index) {
+	if (index < 2 * SUB_BUCKETS)
+		return index;
+	int shift = index / SUB_BUCKETS - 1;
+	return (((uint64_t)(index % SUB_BUCKETS + SUB_BUCKETS) + 1) << shift) - 1;
+}
+
+//Returns the value below which 'fraction' of the samples fall. Internal to this module.
+uint64_t percentile(struct Histogram * h, uint64_t count, double fraction) {
+	uint64_t target = (uint64_t)(fraction * count + 0.5);
+	uint64_t seen = 0;
+	int i;
+
+	if (target == 0)
+		target = 1;
+	for (i = 0; i < NUM_BUCKETS; i++) {
+		seen += __atomic_load_n(&h->buckets[i], __ATOMIC_RELAXED);
+		if (seen >= target)
+			return bucket_max(i) < h->max ? bucket_max(i) : h->max;
+	}
+	return h->max;
+}
+
+//Records a SIGUSR1. Internal to this module.
+void handle_sigusr1(int signal) {
+	mDumpRequested = 1;
+}
+
+//Installs the SIGUSR1 handler and dumps the histograms at exit
+void prof_init() {
+	struct sigaction action;
+	action.sa_handler = handle_sigusr1;
+	sigemptyset(&action.sa_mask);
+	action.sa_flags = SA_RESTART;
+	sigaction(SIGUSR1, &action, NULL);
+	atexit(prof_dump);
+}
+
+//Dumps the histograms if SIGUSR1 was received since the last call
+void prof_poll() {
+	if (mDumpRequested) {
+		mDumpRequested = 0;
+		prof_dump();
+	}
+}
+
+//Prints the histograms to stderr
+void prof_dump() {
+	int event;
+	fprintf(stderr, "\nDispatcher overhead (ns)\n");
+	fprintf(stderr, "%-10s %10s %10s %10s %10s %10s %10s %10s\n",
+			"event", "count", "mean", "p50", "p90", "p99", "p99.9", "max");
+	for (event = 0; event < PROF_EVENTS; event++) {
+		struct Histogram * h = &mHistograms[event];
+		uint64_t count = __atomic_load_n(&h->count, __ATOMIC_RELAXED);
+		if (count == 0) {
+			fprintf(stderr, "%-10s %10d\n", mEventNames[event], 0);
+			continue;
+		}
+		fprintf(stderr, "%-10s %10llu %10llu %10llu %10llu %10llu %10llu %10llu\n", mEventNames[event],
+				(unsigned long long)count,
+				(unsigned long long)(__atomic_load_n(&h->total, __ATOMIC_RELAXED) / count),
+				(unsigned long long)percentile(h, count, 0.5),
+				(unsigned long long)percentile(h, count, 0.9),
+				(unsigned long long)percentile(h, count, 0.99),
+				(unsigned long long)percentile(h, count, 0.999),
+				(unsigned long long)__atomic_load_n(&h->max, __ATOMIC_RELAXED));
+	}
+}
+
+//Returns a monotonic timestamp in nanoseconds
+uint64_t prof_now() {
+	struct timespec now;
+	clock_gettime(CLOCK_MONOTONIC, &now);
+	return (uint64_t)now.tv_sec * 1000000000ull + now.tv_nsec;
+}
+
+//Adds a sample to an event's histogram
+void prof_record(int event, uint64_t nanoseconds) {
+	struct Histogram * h = &mHistograms[event];
+	uint64_t max = __atomic_load_n(&h->max, __ATOMIC_RELAXED);
+
+	__atomic_fetch_add(&h->buckets[bucket_index(nanoseconds)], 1, __ATOMIC_RELAXED);
+	__atomic_fetch_add(&h->total, nanoseconds, __ATOMIC_RELAXED);
+	while (nanoseconds > max &&
+			!__atomic_compare_exchange_n(&h->max, &max, nanoseconds, true, __ATOMIC_RELAXED, __ATOMIC_RELAXED));
+	__atomic_fetch_add(&h->count, 1, __ATOMIC_RELAXED);
+}
+
+//Opens a close-on-exec pipe
+void prof_exec_pipe(int fds[2]) {
+	if (pipe2(fds, O_CLOEXEC) != 0)
+		fds[0] = fds[1] = -1;
+}
+
+//Waits until every process holding the pipe's write end has called exec
+void prof_exec_wait(int fds[2]) {
+	char buffer;
+	if (fds[0] < 0)
+		return;
+	close(fds[1]);
+	while (read(fds[0], &buffer, 1) > 0);	//Returns 0 once the last write end is closed
+	close(fds[0]);
+}
+
+//Closes the pipe without waiting for a child
+void prof_exec_cancel(int fds[2]) {
+	if (fds[0] < 0)
+		return;
+	close(fds[0]);
+	close(fds[1]);
+}
+
+#endif
@@ -15,35 +15,59 @@ int arraySize(const void** array) {
 	for(count = 0; array[count] != NULL; count++);
 	return count;		
 }
-//Reads a line in format "<int1>, <int2>, ..., <int8>" from a filestream and returns the 
-//int values in an malloced array of size 8.
+//Reads a line in format "<int1>, <int2>, ..., <int8>[, <int9>]" from a filestream and returns the
+//int values in an malloced array of size MAX_FIELDS. Missing optional values are set to 0.
 int * readInfo(FILE *file) {
-	const int SIZE = 8;
-	int * array = malloc(sizeof(int) * SIZE);
+	int * array = malloc(sizeof(int) * MAX_FIELDS);
 	int index = 0;
 	//Read line
-	while(!feof(file) && index < SIZE) {
-		char number[] = "\0\0\0\0";
+	while(!feof(file) && index < MAX_FIELDS) {
+		char number[12] = {0};	//Large enough for any positive int
 		char digit = '\0';
 		int i = 0;
 		while (!feof(file) && isdigit(digit = fgetc(file) ) )
-			number[i++] = digit;			
-					
+			if(i < sizeof(number) - 1)
+				number[i++] = digit;
+
 		if(strlen(number) > 0)
 			array[index++] = atoi(number);
-			
+
 		if(digit == NEWLINE)
 			break;
 	}	
 	/*Single newline encountered. Set array to NULL to indicate the read failed*/
-	if(index < SIZE) {
+	if(index < REQUIRED_FIELDS) {
 		free(array);
 		array = NULL;
+	} else {
+		/*Optional values that were omitted default to 0*/
+		while(index < MAX_FIELDS)
+			array[index++] = 0;
 	}
 	
 	return array;
 }
 
+//Same as readInfo(), but parses a NULL-terminated string.
+int * parseInfo(const char *line) {
+	int * array = malloc(sizeof(int) * MAX_FIELDS);
+	int index = 0;
+	while(*line != '\0' && index < MAX_FIELDS) {
+		if(isdigit(*line))
+			array[index++] = (int)strtol(line, (char **)&line, 10);
+		else
+			line++;
+	}
+	if(index < REQUIRED_FIELDS) {
+		free(array);
+		return NULL;
+	}
+	/*Optional values that were omitted default to 0*/
+	while(index < MAX_FIELDS)
+		array[index++] = 0;
+	return array;
+}
+
 //Reads the contents of a file and stores them in a string.
 void read_file(FILE* file, char* buffer, size_t size) {
 	int i;
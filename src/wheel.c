@@ -0,0 +1,114 @@
+/***********************************************
+ * File: wheel.c
+ * Description: Hierarchical timer wheel that holds processes until
+   their arrival time. Insertion is O(1) and advancing by one tick is
+   O(1) plus the number of processes that become due or are cascaded.
+***********************************************/
+
+#include <stdlib.h>
+#include <stdio.h>
+#include "../inc/wheel.h"
+
+#define DEBUG_WHEEL false	//Debug flag specific to this file
+#define WHEEL_SPAN_BITS (WHEEL_BITS * WHEEL_LEVELS)
+
+//Places a process in the slot for its arrival time relative to the current tick. Internal to this module.
+void wheel_place(timer_wheel * w, pcbptr process) {
+	unsigned int time = process->arrival_time;
+	int level;
+
+	if (time < w->current) {
+		enqueue(&w->due, process);
+		return;
+	}
+
+	/*Use the lowest level whose slot range still contains both the arrival time and the current tick*/
+	for (level = 0; level < WHEEL_LEVELS; level++) {
+		unsigned int shift = WHEEL_BITS * (level + 1);
+		if ((time >> shift) == (w->current >> shift)) {
+			enqueue(&w->slots[level][(time >> (WHEEL_BITS * level)) & WHEEL_MASK], process);
+			return;
+		}
+	}
+
+	heap_push(&w->overflow, process->arrival_time, process);
+}
+
+//Re-places every process of a slot now that the current tick has entered its range. Internal to this module.
+void wheel_cascade(timer_wheel * w, int level) {
+	queue * slot = &w->slots[level][(w->current >> (WHEEL_BITS * level)) & WHEEL_MASK];
+	pcbptr process = slot->front;
+	init_queue(slot);
+
+	while (process != NULL) {
+		pcbptr next = process->next;
+		wheel_place(w, process);
+		process = next;
+	}
+}
+
+//Initializes an empty wheel
+void init_wheel(timer_wheel * w) {
+	int level, slot;
+	w->current = 0;
+	w->count = 0;
+	for (level = 0; level < WHEEL_LEVELS; level++)
+		for (slot = 0; slot < WHEEL_SLOTS; slot++)
+			init_queue(&w->slots[level][slot]);
+	init_queue(&w->due);
+	init_heap(&w->overflow);
+}
+
+//Adds process to the wheel
+void wheel_insert(timer_wheel * w, pcbptr process) {
+	wheel_place(w, process);
+	w->count++;
+}
+
+//Makes every process that arrives at or before 'time' due
+void wheel_advance(timer_wheel * w, unsigned int time) {
+	int level;
+
+	while (w->current <= time) {
+		/*At a level boundary, move the processes of the slots just entered down the wheel (highest level first)*/
+		if ((w->current & WHEEL_MASK) == 0) {
+			if ((w->current & ((1u << WHEEL_SPAN_BITS) - 1)) == 0) {
+				/*The wheel wrapped around. Bring in the overflow processes that now fit.*/
+				while (!isEmptyHeap(w->overflow) &&
+						((unsigned int)heap_peek_key(w->overflow) >> WHEEL_SPAN_BITS) == (w->current >> WHEEL_SPAN_BITS))
+					wheel_place(w, heap_pop(&w->overflow));
+			}
+			for (level = WHEEL_LEVELS - 1; level > 0; level--)
+				if ((w->current & ((1u << (WHEEL_BITS * level)) - 1)) == 0)
+					wheel_cascade(w, level);
+		}
+
+		/*Append the processes of the current tick to the due queue*/
+		queue * slot = &w->slots[0][w->current & WHEEL_MASK];
+		if (!isEmptyQueue(*slot)) {
+			if (isEmptyQueue(w->due))
+				w->due.front = slot->front;
+			else
+				w->due.back->next = slot->front;
+			w->due.back = slot->back;
+			init_queue(slot);
+		}
+
+		if (DEBUG_WHEEL && !isEmptyQueue(w->due))
+			printf("\tWheel tick %u: processes due\n", w->current);
+		w->current++;
+	}
+}
+
+//Removes a due process
+pcbptr wheel_pop_due(timer_wheel * w) {
+	pcbptr process = dequeue(&w->due);
+	if (process != NULL)
+		w->count--;
+	return process;
+}
+
+//Returns true if the wheel holds no processes. False otherwise
+bool isEmptyWheel(timer_wheel * w) {
+	return w->count == 0;
+}